@@ -36,6 +36,7 @@
 #define SERIAL0_TX_FUNC         1
 #define SERIAL0_TX_BUFF_SIZE    32
 #define SERIAL0_HAS_OE          0
+#define SERIAL0_HAS_DMA         1
 
 // SERIAL1 (cli)
 #define SERIAL1
@@ -50,6 +51,7 @@
 #define SERIAL1_TX_FUNC         1
 #define SERIAL1_TX_BUFF_SIZE    64
 #define SERIAL1_HAS_OE          0
+#define SERIAL1_HAS_DMA         0
 
 // SERIAL2 (system callbacks)
 #define SERIAL2
@@ -64,6 +66,10 @@
 #define SERIAL2_TX_FUNC         2
 #define SERIAL2_TX_BUFF_SIZE    32
 #define SERIAL2_HAS_OE          0
+#define SERIAL2_HAS_DMA         1
+
+// GPDMA interrupt priority, used by the serials with DMA
+#define SERIAL_DMA_PRIORITY     1
 
 //// Hardware peripheral definitions
 // Clock power control
@@ -177,6 +183,8 @@ enum {ENCODER0, ENCODER1, ENCODER2, FOOTSWITCH0, FOOTSWITCH1, FOOTSWITCH2, BUTTO
 // define how many bytes will be allocated to rx/tx buffers
 #define WEBGUI_COMM_RX_BUFF_SIZE    4096
 #define WEBGUI_COMM_TX_BUFF_SIZE    512
+// define how many tokens a received message can be split in
+#define WEBGUI_COMM_MAX_TOKENS      256
 
 //// webgui configuration
 // define the interface
@@ -185,6 +193,8 @@ enum {ENCODER0, ENCODER1, ENCODER2, FOOTSWITCH0, FOOTSWITCH1, FOOTSWITCH2, BUTTO
 // define how many bytes will be allocated to rx/tx buffers
 #define SYSTEM_COMM_RX_BUFF_SIZE    4096
 #define SYSTEM_COMM_TX_BUFF_SIZE    512
+// define how many tokens a received message can be split in
+#define SYSTEM_COMM_MAX_TOKENS      64
 
 //// Command line interface configurations
 // defines the cli serial
@@ -483,6 +493,9 @@ enum {ENCODER0, ENCODER1, ENCODER2, FOOTSWITCH0, FOOTSWITCH1, FOOTSWITCH2, BUTTO
 #define FOOT_CONTROLS_TIMEOUT       700
 #define MSG_TIMEOUT                 800
 
+//minimum time between two control values sent for the same actuator while turning (in milliseconds)
+#define CONTROL_SET_INTERVAL        20
+
 //defines the timeout of the LEDS in us
 #define LED_INTERUPT_TIME                 16
 
@@ -577,6 +590,20 @@ enum {ENCODER0, ENCODER1, ENCODER2, FOOTSWITCH0, FOOTSWITCH1, FOOTSWITCH2, BUTTO
 #define SERIAL3_TX_BUFF_SIZE    0
 #endif
 
+// check serial DMA mode
+#ifndef SERIAL0_HAS_DMA
+#define SERIAL0_HAS_DMA         0
+#endif
+#ifndef SERIAL1_HAS_DMA
+#define SERIAL1_HAS_DMA         0
+#endif
+#ifndef SERIAL2_HAS_DMA
+#define SERIAL2_HAS_DMA         0
+#endif
+#ifndef SERIAL3_HAS_DMA
+#define SERIAL3_HAS_DMA         0
+#endif
+
 #define SERIAL_MAX_RX_BUFF_SIZE     MAX(MAX(SERIAL0_RX_BUFF_SIZE, SERIAL1_RX_BUFF_SIZE), \
                                         MAX(SERIAL2_RX_BUFF_SIZE, SERIAL3_RX_BUFF_SIZE))
 
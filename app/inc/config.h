@@ -0,0 +1 @@
+config-moddwarf.h
\ No newline at end of file
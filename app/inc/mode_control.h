@@ -58,6 +58,8 @@ void CM_init(void);
 void CM_add_control(control_t *control, uint8_t protocol);
 void CM_remove_control(uint8_t hw_id);
 control_t *CM_get_control(uint8_t hw_id);
+void CM_send_queued_control_sets(uint8_t force);
+uint32_t CM_queued_control_sets_timeout(void);
 void CM_inc_control(uint8_t encoder);
 void CM_dec_control(uint8_t encoder);
 void CM_toggle_control(uint8_t encoder);
@@ -43,6 +43,7 @@
 */
 
 // This struct is used on callbacks argument
+// list is borrowed from the msg_t and is only valid during the callback
 typedef struct PROTO_T {
     char **list;
     uint32_t list_count;
@@ -51,10 +52,14 @@ typedef struct PROTO_T {
 } proto_t;
 
 // This struct must be used to pass a message to protocol parser
+// list is owned by the caller and receives the message tokens, so parsing
+// does not need to allocate memory
 typedef struct MSG_T {
     int sender_id;
     char *data;
     uint32_t data_size;
+    char **list;
+    uint32_t list_size;
 } msg_t;
 
 
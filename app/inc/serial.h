@@ -45,6 +45,10 @@
 // output enable pin level
 #define OUTPUT_ENABLE_ACTIVE_IN_HIGH
 
+// size of the circular buffer written by the rx DMA (DMA mode only)
+// the received data is processed every half buffer or when the line is polled
+#define SERIAL_DMA_RX_BUFF_SIZE 512
+
 
 /*
 ************************************************************************************************************************
@@ -52,6 +56,11 @@
 ************************************************************************************************************************
 */
 
+// GPDMA linked list item
+typedef struct SERIAL_DMA_LLI_T {
+    uint32_t src, dst, next, control;
+} serial_dma_lli_t;
+
 typedef struct SERIAL_T {
     uint8_t uart_id;
     uint32_t baud_rate;
@@ -64,9 +73,24 @@ typedef struct SERIAL_T {
     ringbuff_t *tx_buffer;
     void (*rx_callback)(struct SERIAL_T *serial);
 
+    // frame mode, messages are assembled by the interrupt directly in rx_frames
+    uint8_t *rx_frames;
+    uint32_t rx_frames_size;
+    uint32_t rx_frames_head, rx_frames_start;
+    volatile uint32_t rx_frames_tail;
+    uint8_t rx_frames_overflow;
+    uint8_t (*rx_frame_callback)(struct SERIAL_T *serial, uint8_t *frame, uint32_t frame_size);
+
     // output enable
     uint8_t has_oe;
     uint8_t oe_port, oe_pin;
+
+    // DMA mode, rx goes to a circular buffer and tx is sent straight from the tx ring buffer
+    uint8_t has_dma;
+    uint8_t *dma_rx_buffer;
+    uint32_t dma_rx_read;
+    serial_dma_lli_t dma_rx_lli[2];
+    volatile uint32_t dma_tx_count;
 } serial_t;
 
 
@@ -92,11 +116,27 @@ typedef struct SERIAL_T {
 
 void serial_init(serial_t *serial);
 void serial_enable_interupt(serial_t *serial);
+// blocks (sleeping) until all data is in the tx buffer
 uint32_t serial_send(uint8_t uart_id, const uint8_t *data, uint32_t data_size);
+// same as serial_send but gives up after timeout ticks, returns how many bytes were buffered
+uint32_t serial_send_timeout(uint8_t uart_id, const uint8_t *data, uint32_t data_size, uint32_t timeout);
 uint32_t serial_read(uint8_t uart_id, uint8_t *data, uint32_t data_size);
 uint32_t serial_read_until(uint8_t uart_id, uint8_t *data, uint32_t data_size, uint8_t token);
 void serial_set_callback(uint8_t uart_id, void (*receive_cb)(serial_t *serial));
 void serial_flush_tx_buffer(uint8_t uart_id);
+// indexes the delimiter in the rx buffer, so serial_read_until doesn't scan the whole buffer
+uint8_t serial_set_rx_delimiter(uint8_t uart_id, uint8_t delimiter, uint32_t max_count);
+
+// switches the uart to frame mode: the interrupt assembles the 0 terminated messages in a buffer of
+// buffer_size bytes and passes them to frame_cb, which must return non zero when the frame is accepted.
+// An accepted frame stays valid until it is released, frames must be released in the order they came
+// in frame mode the rx ring buffer and rx_callback are not used
+uint8_t serial_set_frame_callback(uint8_t uart_id, uint32_t buffer_size,
+                                  uint8_t (*frame_cb)(serial_t *serial, uint8_t *frame, uint32_t frame_size));
+void serial_release_frame(uint8_t uart_id, const uint8_t *frame, uint32_t frame_size);
+// processes the data received by the DMA mode uarts, must be called periodically
+// (it is what detects the end of the messages shorter than half DMA buffer)
+void serial_dma_poll(void);
 
 // this function will be called automatically from UART interrupt in case of error
 // the user must create this function in your application code
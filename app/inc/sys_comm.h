@@ -66,8 +66,10 @@ void sys_comm_init(void);
 //// webgui communication functions
 // sends a message to webgui
 void sys_comm_send(const char *command, const char *arguments);
-// read a message from webgui
-ringbuff_t* sys_comm_read(void);
+// blocks until a message is received, returns it and its size (terminator included)
+// the message is parsed in place and must be released, in order, when done
+char* sys_comm_read(uint32_t *msg_size);
+void sys_comm_release(const char *msg, uint32_t msg_size);
 // sets a function callback to webgui response
 void sys_comm_set_response_cb(void (*resp_cb)(void *data, menu_item_t *item), menu_item_t *item);
 // invokes the response function callback
@@ -32,6 +32,9 @@
 ************************************************************************************************************************
 */
 
+// defines how many pipelined requests can wait for a webgui response at the same time
+#define WEBGUI_MAX_PENDING_REQUESTS     4
+
 
 /*
 ************************************************************************************************************************
@@ -66,8 +69,16 @@ void ui_comm_init(void);
 //// webgui communication functions
 // sends a message to webgui
 void ui_comm_webgui_send(const char *data, uint32_t data_size);
-// read a message from webgui
-ringbuff_t* ui_comm_webgui_read(void);
+// sends a request without waiting for the response, req_cb is invoked (from the
+// protocol task) when the response arrives. Blocks only if the pipeline is full.
+// Requests are answered in order, messages sent by ui_comm_webgui_send wait for them
+void ui_comm_webgui_send_request(const char *data, uint32_t data_size, void (*req_cb)(void *data, void *arg), void *arg);
+// returns how many pipelined requests are still waiting for the response
+uint8_t ui_comm_webgui_pending_requests(void);
+// blocks until a message from webgui is received, returns it and its size (terminator included)
+// the message is parsed in place and must be released, in order, when done
+char* ui_comm_webgui_read(uint32_t *msg_size);
+void ui_comm_webgui_release(const char *msg, uint32_t msg_size);
 // sets a function callback to webgui response
 void ui_comm_webgui_set_response_cb(void (*resp_cb)(void *data, menu_item_t *item), menu_item_t *item);
 // invokes the response function callback
@@ -44,10 +44,18 @@
 ************************************************************************************************************************
 */
 
+// single producer/single consumer: the producer only moves head, the consumer only moves tail
 typedef struct RINGBUFF_T {
-    uint32_t head, tail;
+    volatile uint32_t head, tail;
     uint8_t *buffer;
-    uint32_t size;
+    uint32_t size, mask;
+
+    // optional positions of the delimiters not read yet (see ringbuff_set_delimiter)
+    uint32_t *delimiters;
+    uint32_t delimiters_size;
+    volatile uint32_t delimiters_head, delimiters_tail;
+    uint8_t delimiter;
+    volatile uint8_t delimiters_overflow;
 } ringbuff_t;
 
 
@@ -74,6 +82,9 @@ typedef struct RINGBUFF_T {
 uint8_t copy_command(char *buffer, const char *command);
 // splits the string in each whitespace occurrence and returns a array of strings NULL terminated
 char** strarr_split(char *str, const char token);
+// same as strarr_split but fills the given list instead of allocating it, the list is NULL
+// terminated. Returns the number of tokens or -1 if they don't fit in list_size pointers
+int32_t strarr_split_into(char *str, const char token, char **list, uint32_t list_size);
 // returns the string array length
 uint32_t strarr_length(char** const str_array);
 // joins a string array in a single string
@@ -101,14 +112,21 @@ float convert_to_ms(const char *unit_from, float value);
 float convert_from_ms(const char *unit_to, float value);
 
 // ring buffer functions
-// ringbuff_create: allocates memory to ring buffer
+// ringbuff_create: allocates memory to ring buffer, the size is rounded up to a power of two
 ringbuff_t *ringbuff_create(uint32_t buffer_size);
 // ringbuff_destroy: de-allocates memory of the ring buffer
 void ringbuff_destroy(ringbuff_t *rb);
+// ringbuff_set_delimiter: keeps the positions of up to max_count delimiters, so counting and reading
+//                        until the delimiter don't need to scan the buffer. Returns zero if no memory
+uint8_t ringbuff_set_delimiter(ringbuff_t *rb, uint8_t delimiter, uint32_t max_count);
 // ringbuff_write: returns number of bytes written
 uint32_t ringbuff_write(ringbuff_t *rb, const uint8_t *data, uint32_t data_size);
 // ringbuff_read: returns number of bytes read
 uint32_t ringbuff_read(ringbuff_t *rb, uint8_t *buffer, uint32_t buffer_size);
+// ringbuff_peek_span: points data to the unread bytes and returns how many are contiguous
+uint32_t ringbuff_peek_span(ringbuff_t *rb, uint8_t **data);
+// ringbuff_commit: releases count bytes, usually after using the data given by ringbuff_peek_span
+void ringbuff_commit(ringbuff_t *rb, uint32_t count);
 // ringbuff_read_until: read ring buffer until find the token and returns number of bytes read
 uint32_t ringbuff_read_until(ringbuff_t *rb, uint8_t *buffer, uint32_t buffer_size, uint8_t token);
 // ringbuffer_used_space: returns amount of unread bytes
@@ -119,7 +137,7 @@ uint32_t ringbuff_available_space(ringbuff_t *rb);
 uint32_t ringbuff_is_full(ringbuff_t *rb);
 // ringbuff_is_empty: returns non zero if buffer is empty
 uint32_t ringbuff_is_empty(ringbuff_t *rb);
-// ringbuff_flush: reset buffer indexes (old data will be overwritten)
+// ringbuff_flush: reset buffer indexes (old data will be overwritten), the other side must not be using the buffer
 void ringbuff_flush(ringbuff_t *rb);
 // ringbuff_count: returns amount of ocurrencies of byte in the buffer
 uint32_t ringbuff_count(ringbuff_t *rb, uint8_t byte);
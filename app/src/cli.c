@@ -37,6 +37,8 @@
 #define RESTORE_HOSTNAME    "mod-restore"
 
 #define PEEK_SIZE           3
+// how many received lines are indexed in the rx buffer
+#define CLI_MAX_LINES       8
 #define RESPONSE_TIMEOUT    (CLI_RESPONSE_TIMEOUT / portTICK_RATE_MS)
 #define BOOT_TIMEOUT        (3000 / portTICK_RATE_MS)
 
@@ -241,6 +243,7 @@ void cli_init(void)
     vSemaphoreCreateBinary(g_received_sem);
     vSemaphoreCreateBinary(g_response_sem);
     serial_set_callback(CLI_SERIAL, serial_cb);
+    serial_set_rx_delimiter(CLI_SERIAL, '\n', CLI_MAX_LINES);
 
     // vSemaphoreCreateBinary is created as available which makes
     // first xSemaphoreTake pass even if semaphore has not been given
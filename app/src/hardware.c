@@ -710,6 +710,7 @@ void hardware_setup(void)
     g_serial[0].tx_function = SERIAL0_TX_FUNC;
     g_serial[0].tx_buffer_size = SERIAL0_TX_BUFF_SIZE;
     g_serial[0].has_oe = SERIAL0_HAS_OE;
+    g_serial[0].has_dma = SERIAL0_HAS_DMA;
     #if SERIAL0_HAS_OE
     g_serial[0].oe_port = SERIAL0_OE_PORT;
     g_serial[0].oe_pin = SERIAL0_OE_PIN;
@@ -730,6 +731,7 @@ void hardware_setup(void)
     g_serial[1].tx_function = SERIAL1_TX_FUNC;
     g_serial[1].tx_buffer_size = SERIAL1_TX_BUFF_SIZE;
     g_serial[1].has_oe = SERIAL1_HAS_OE;
+    g_serial[1].has_dma = SERIAL1_HAS_DMA;
     #if SERIAL1_HAS_OE
     g_serial[1].oe_port = SERIAL1_OE_PORT;
     g_serial[1].oe_pin = SERIAL1_OE_PIN;
@@ -750,6 +752,7 @@ void hardware_setup(void)
     g_serial[2].tx_function = SERIAL2_TX_FUNC;
     g_serial[2].tx_buffer_size = SERIAL2_TX_BUFF_SIZE;
     g_serial[2].has_oe = SERIAL2_HAS_OE;
+    g_serial[2].has_dma = SERIAL2_HAS_DMA;
     #if SERIAL2_HAS_OE
     g_serial[2].oe_port = SERIAL2_OE_PORT;
     g_serial[2].oe_pin = SERIAL2_OE_PIN;
@@ -770,6 +773,7 @@ void hardware_setup(void)
     g_serial[3].tx_function = SERIAL3_TX_FUNC;
     g_serial[3].tx_buffer_size = SERIAL3_TX_BUFF_SIZE;
     g_serial[3].has_oe = SERIAL3_HAS_OE;
+    g_serial[3].has_dma = SERIAL3_HAS_DMA;
     #if SERIAL3_HAS_OE
     g_serial[3].oe_port = SERIAL3_OE_PORT;
     g_serial[3].oe_pin = SERIAL3_OE_PIN;
@@ -965,6 +969,9 @@ void TIMER1_IRQHandler(void)
     {
         actuators_clock();
         g_counter++;
+
+        // picks up the DMA received messages
+        serial_dma_poll();
     }
 
     TIM_ClearIntPending(LPC_TIM1, TIM_MR1_INT);
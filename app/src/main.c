@@ -26,6 +26,7 @@
 #include "sys_comm.h"
 #include "images.h"
 #include "uc1701.h"
+#include "mode_control.h"
 #include "mode_navigation.h"
 #include "mode_tools.h"
 
@@ -73,8 +74,8 @@
 */
 
 static volatile xQueueHandle g_actuators_queue;
-static uint8_t g_comm_msg_buffer[WEBGUI_COMM_RX_BUFF_SIZE];
-static uint8_t g_sys_msg_buffer[SYSTEM_COMM_RX_BUFF_SIZE];
+static char *g_comm_msg_tokens[WEBGUI_COMM_MAX_TOKENS + 1];
+static char *g_sys_msg_tokens[SYSTEM_COMM_MAX_TOKENS + 1];
 
 /*
 ************************************************************************************************************************
@@ -207,17 +208,20 @@ static void webgui_procotol_task(void *pvParameters)
     {
         uint32_t msg_size;
         // blocks until receive a new message
-        ringbuff_t *rb = ui_comm_webgui_read();
-        msg_size = ringbuff_read_until(rb, g_comm_msg_buffer, WEBGUI_COMM_RX_BUFF_SIZE, 0);
+        char *data = ui_comm_webgui_read(&msg_size);
 
-        // parses the message
+        // parses the message in place
         if (msg_size > 0)
         {
             msg_t msg;
             msg.sender_id = WEBGUI_SERIAL;
-            msg.data = (char *) g_comm_msg_buffer;
+            msg.data = data;
             msg.data_size = msg_size;
+            msg.list = g_comm_msg_tokens;
+            msg.list_size = sizeof(g_comm_msg_tokens) / sizeof(g_comm_msg_tokens[0]);
             protocol_parse(&msg);
+
+            ui_comm_webgui_release(data, msg_size);
         }
     }
 }
@@ -232,17 +236,20 @@ static void system_procotol_task(void *pvParameters)
     {
         uint32_t msg_size;
         // blocks until receive a new message
-        ringbuff_t *rb = sys_comm_read();
-        msg_size = ringbuff_read_until(rb, g_sys_msg_buffer, SYSTEM_COMM_RX_BUFF_SIZE, 0);
-        // parses the message
+        char *data = sys_comm_read(&msg_size);
+        // parses the message in place
         if (msg_size > 0)
         {
             //if parsing messages block the actuator messages.
             msg_t msg;
             msg.sender_id = SYSTEM_SERIAL;
-            msg.data = (char *) g_sys_msg_buffer;
+            msg.data = data;
             msg.data_size = msg_size;
+            msg.list = g_sys_msg_tokens;
+            msg.list_size = sizeof(g_sys_msg_tokens) / sizeof(g_sys_msg_tokens[0]);
             protocol_parse(&msg);
+
+            sys_comm_release(data, msg_size);
         }
     }
 }
@@ -298,8 +305,11 @@ static void actuators_task(void *pvParameters)
     {
         portBASE_TYPE xStatus;
 
-        // take the actuator from queue
-        xStatus = xQueueReceive(g_actuators_queue, &actuator_info, portMAX_DELAY);
+        // take the actuator from queue, wakes up earlier when a coalesced control value is due
+        xStatus = xQueueReceive(g_actuators_queue, &actuator_info, CM_queued_control_sets_timeout());
+
+        // sends the latest value of the controls being turned
+        CM_send_queued_control_sets(0);
 
         // checks if actuator has successfully taken
         if (xStatus == pdPASS && cli_restore(RESTORE_STATUS) == LOGGED_ON_SYSTEM && g_device_booted)
@@ -82,6 +82,13 @@ static uint8_t g_fs_page_available[8] = {0, 0, 0, 0, 0, 0, 0, 0};
 static uint8_t g_available_foot_pages = 0;
 static int8_t g_current_overlay_actuator = -1;
 static bool g_list_click = 0;
+
+// latest control value waiting to be sent to mod-ui, per control actuator
+static struct CONTROL_SET_MAILBOX_T {
+    float value;
+    uint8_t pending;
+    portTickType last_send;
+} g_control_set_mailbox[TOTAL_CONTROL_ACTUATORS];
 /*
 ************************************************************************************************************************
 *           LOCAL FUNCTION PROTOTYPES
@@ -219,7 +226,7 @@ static void clone_list_encoders(control_t *control)
     }
 }
 
-static void send_control_set(control_t *control)
+static void send_control_value(uint8_t hw_id, float value)
 {
     char buffer[128];
     uint8_t i;
@@ -227,18 +234,64 @@ static void send_control_set(control_t *control)
     i = copy_command(buffer, CMD_CONTROL_SET);
 
     // insert the hw_id on buffer
-    i += int_to_str(control->hw_id, &buffer[i], sizeof(buffer) - i, 0);
+    i += int_to_str(hw_id, &buffer[i], sizeof(buffer) - i, 0);
     buffer[i++] = ' ';
 
     // insert the value on buffer
-    i += float_to_str(control->value, &buffer[i], sizeof(buffer) - i, 3);
+    i += float_to_str(value, &buffer[i], sizeof(buffer) - i, 3);
     buffer[i] = 0;
 
-    // sends the data to GUI
-    ui_comm_webgui_send(buffer, i);
+    if (hw_id < TOTAL_CONTROL_ACTUATORS)
+        g_control_set_mailbox[hw_id].last_send = xTaskGetTickCount();
 
-    //wait for a response from mod-ui
-    ui_comm_webgui_wait_response();
+    // sends the data to GUI, the response is tracked by ui_comm so we can
+    // keep handling actuator events while mod-ui processes it
+    ui_comm_webgui_send_request(buffer, i, NULL, NULL);
+}
+
+static void send_control_set(control_t *control)
+{
+    // this value is newer than the one waiting in the mailbox
+    if (control->hw_id < TOTAL_CONTROL_ACTUATORS)
+        g_control_set_mailbox[control->hw_id].pending = 0;
+
+    send_control_value(control->hw_id, control->value);
+}
+
+static void send_mailbox_control_set(uint8_t hw_id)
+{
+    float value;
+
+    taskENTER_CRITICAL();
+    value = g_control_set_mailbox[hw_id].value;
+    g_control_set_mailbox[hw_id].pending = 0;
+    taskEXIT_CRITICAL();
+
+    send_control_value(hw_id, value);
+}
+
+// continuous values are coalesced, only the latest one is sent at most once per
+// CONTROL_SET_INTERVAL, triggers, toggles and momentary controls are always sent
+static void queue_control_set(control_t *control)
+{
+    if ((control->hw_id >= TOTAL_CONTROL_ACTUATORS) ||
+        (control->properties & (FLAG_CONTROL_TRIGGER | FLAG_CONTROL_TOGGLED | FLAG_CONTROL_BYPASS |
+                                FLAG_CONTROL_MOMENTARY | FLAG_CONTROL_TAP_TEMPO)))
+    {
+        send_control_set(control);
+        return;
+    }
+
+    struct CONTROL_SET_MAILBOX_T *mailbox = &g_control_set_mailbox[control->hw_id];
+
+    taskENTER_CRITICAL();
+    mailbox->value = control->value;
+    mailbox->pending = 1;
+    taskEXIT_CRITICAL();
+
+    // a single step is sent right away
+    if ((xTaskGetTickCount() - mailbox->last_send) >= (CONTROL_SET_INTERVAL / portTICK_RATE_MS))
+        send_mailbox_control_set(control->hw_id);
 }
 
 void set_footswitch_pages_led_state(void)
@@ -285,6 +338,9 @@ static void load_control_page(uint8_t page)
     hardware_force_overlay_off(1);
     g_current_overlay_actuator = -1;
 
+    //the last values of the current page still need to reach mod-ui
+    CM_send_queued_control_sets(1);
+
     uint8_t i = copy_command(buffer, CMD_NEXT_PAGE);
     i += int_to_str(page, &buffer[i], sizeof(buffer) - i, 0);
 
@@ -990,7 +1046,7 @@ static void control_set(uint8_t id, control_t *control)
         && (control->hw_id < ENCODERS_COUNT))
         return;
 
-    send_control_set(control);
+    queue_control_set(control);
 }
 
 /*
@@ -1028,6 +1084,10 @@ void CM_remove_control(uint8_t hw_id)
 {
     if (!g_initialized) return;
 
+    // a value waiting in the mailbox belongs to the removed control
+    if (hw_id < TOTAL_CONTROL_ACTUATORS)
+        g_control_set_mailbox[hw_id].pending = 0;
+
     if (hw_id < 3) encoder_control_rm(hw_id);
     else foot_control_rm(hw_id);
 }
@@ -1063,6 +1123,43 @@ control_t *CM_get_control(uint8_t hw_id)
         return g_foots[hw_id - ENCODERS_COUNT];
 }
 
+void CM_send_queued_control_sets(uint8_t force)
+{
+    uint8_t hw_id;
+    portTickType now = xTaskGetTickCount();
+
+    for (hw_id = 0; hw_id < TOTAL_CONTROL_ACTUATORS; hw_id++)
+    {
+        if (!g_control_set_mailbox[hw_id].pending)
+            continue;
+
+        if (force || ((now - g_control_set_mailbox[hw_id].last_send) >= (CONTROL_SET_INTERVAL / portTICK_RATE_MS)))
+            send_mailbox_control_set(hw_id);
+    }
+}
+
+uint32_t CM_queued_control_sets_timeout(void)
+{
+    uint8_t hw_id;
+    uint32_t timeout = portMAX_DELAY;
+    portTickType now = xTaskGetTickCount();
+
+    for (hw_id = 0; hw_id < TOTAL_CONTROL_ACTUATORS; hw_id++)
+    {
+        if (!g_control_set_mailbox[hw_id].pending)
+            continue;
+
+        portTickType elapsed = now - g_control_set_mailbox[hw_id].last_send;
+        if (elapsed >= (CONTROL_SET_INTERVAL / portTICK_RATE_MS))
+            return 0;
+
+        if (((CONTROL_SET_INTERVAL / portTICK_RATE_MS) - elapsed) < timeout)
+            timeout = (CONTROL_SET_INTERVAL / portTICK_RATE_MS) - elapsed;
+    }
+
+    return timeout;
+}
+
 void CM_inc_control(uint8_t encoder)
 {
     control_t *control = g_controls[encoder];
@@ -1790,6 +1887,9 @@ void CM_load_next_encoder_page(uint8_t button)
     g_current_encoder_page = button;
     screen_encoder_container(g_current_encoder_page);
 
+    //the last values of the current page still need to reach mod-ui
+    CM_send_queued_control_sets(1);
+
     //clear controls
     uint8_t q;
     for (q = 0; q < ENCODERS_COUNT; q++)
@@ -37,6 +37,9 @@ uint8_t g_screenshot = 0;
 #define FEW_ARGUMENTS       (-3)
 #define INVALID_ARGUMENT    (-4)
 
+// size of the command lookup table, must be a power of two bigger than the amount of commands
+#define COMMANDS_HASH_SIZE  128
+
 
 /*
 ************************************************************************************************************************
@@ -82,6 +85,9 @@ typedef struct CMD_T {
 
 static unsigned int g_command_count = 0;
 static cmd_t g_commands[COMMAND_COUNT_DUO];
+// open addressing table indexed by the hash of the first command token,
+// stores the command index + 1 so zero means empty slot
+static uint8_t g_commands_hash[COMMANDS_HASH_SIZE];
 
 static int8_t *WIDGET_LED_COLORS[]  = {
 #ifdef WIDGET_LED0_COLOR
@@ -136,6 +142,51 @@ static int is_wildcard(const char *str)
     return 0;
 }
 
+static uint32_t token_hash(const char *str)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+
+    while (*str)
+    {
+        hash ^= (uint8_t) *str++;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static void command_hash_insert(unsigned int index)
+{
+    uint32_t slot = token_hash(g_commands[index].list[0]) & (COMMANDS_HASH_SIZE - 1);
+
+    while (g_commands_hash[slot])
+    {
+        // first registered command with this token wins, as the linear search did
+        if (strcmp(g_commands[g_commands_hash[slot] - 1].list[0], g_commands[index].list[0]) == 0)
+            return;
+
+        slot = (slot + 1) & (COMMANDS_HASH_SIZE - 1);
+    }
+
+    g_commands_hash[slot] = index + 1;
+}
+
+static int32_t command_lookup(const char *token)
+{
+    uint32_t slot = token_hash(token) & (COMMANDS_HASH_SIZE - 1);
+
+    while (g_commands_hash[slot])
+    {
+        if (strcmp(g_commands[g_commands_hash[slot] - 1].list[0], token) == 0)
+            return g_commands_hash[slot] - 1;
+
+        slot = (slot + 1) & (COMMANDS_HASH_SIZE - 1);
+    }
+
+    return NOT_FOUND;
+}
+
 
 /*
 ************************************************************************************************************************
@@ -149,25 +200,31 @@ void protocol_parse(msg_t *msg)
     int32_t index = NOT_FOUND;
     proto_t proto;
 
-    proto.list = strarr_split(msg->data, ' ');
-    proto.list_count = strarr_length(proto.list);
+    // splits the message in the token list owned by the caller task
+    int32_t count = strarr_split_into(msg->data, ' ', msg->list, msg->list_size);
+    if (count < 0)
+    {
+        SEND_TO_SENDER(msg->sender_id, g_error_messages[-MANY_ARGUMENTS-1], strlen(g_error_messages[-MANY_ARGUMENTS-1]));
+        return;
+    }
+
+    proto.list = msg->list;
+    proto.list_count = count;
     proto.response = NULL;
 
     // TODO: check invalid argumets (wildcards)
 
-    if (proto.list_count == 0) 
-    {
-        FREE(proto.list);
-        return;
-    }
+    if (proto.list_count == 0) return;
 
     unsigned int match, variable_arguments = 0;
 
-    // loop all registered commands
-    for (i = 0; i < g_command_count; i++)
+    // finds the command by its first token
+    int32_t found = command_lookup(proto.list[0]);
+
+    if (found != NOT_FOUND)
     {
+        i = found;
         match = 0;
-        index = NOT_FOUND;
 
         // checks received protocol
         for (j = 0; j < proto.list_count && j < g_commands[i].count; j++)
@@ -187,33 +244,28 @@ void protocol_parse(msg_t *msg)
             }
         }
 
-        if (match > 0)
+        // checks if the last argument is ...
+        if (j < g_commands[i].count)
         {
-            // checks if the last argument is ...
-            if (j < g_commands[i].count)
-            {
-                if (strcmp(g_commands[i].list[j], "...") == 0) variable_arguments = 1;
-            }
-
-            // few arguments
-            if (proto.list_count < (g_commands[i].count - variable_arguments))
-            {
-                index = FEW_ARGUMENTS;
-            }
+            if (strcmp(g_commands[i].list[j], "...") == 0) variable_arguments = 1;
+        }
 
-            // many arguments
-            else if (proto.list_count > g_commands[i].count && !variable_arguments)
-            {
-                index = MANY_ARGUMENTS;
-            }
+        // few arguments
+        if (proto.list_count < (g_commands[i].count - variable_arguments))
+        {
+            index = FEW_ARGUMENTS;
+        }
 
-            // arguments match
-            else if (match == proto.list_count || variable_arguments)
-            {
-                index = i;
-            }
+        // many arguments
+        else if (proto.list_count > g_commands[i].count && !variable_arguments)
+        {
+            index = MANY_ARGUMENTS;
+        }
 
-            break;
+        // arguments match
+        else if (match == proto.list_count || variable_arguments)
+        {
+            index = i;
         }
     }
 
@@ -239,8 +291,6 @@ void protocol_parse(msg_t *msg)
     {
         SEND_TO_SENDER(msg->sender_id, g_error_messages[-index-1], strlen(g_error_messages[-index-1]));
     }
-
-    FREE(proto.list);
 }
 
 
@@ -253,6 +303,7 @@ void protocol_add_command(const char *command, void (*callback)(uint8_t serial_i
     g_commands[g_command_count].list = strarr_split(cmd, ' ');
     g_commands[g_command_count].count = strarr_length(g_commands[g_command_count].list);
     g_commands[g_command_count].callback = callback;
+    command_hash_insert(g_command_count);
     g_command_count++;
 }
 
@@ -293,6 +344,9 @@ void protocol_remove_commands(void)
         FREE(g_commands[i].command);
         FREE(g_commands[i].list);
     }
+
+    g_command_count = 0;
+    memset(g_commands_hash, 0, sizeof(g_commands_hash));
 }
 
 //initialize all protocol commands
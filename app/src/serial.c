@@ -5,9 +5,15 @@
 ************************************************************************************************************************
 */
 
+#include <string.h>
+
 #include "serial.h"
 #include "device.h"
 
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
 
 /*
 ************************************************************************************************************************
@@ -20,6 +26,9 @@
 #define UART2           ((LPC_UART_TypeDef *)LPC_UART2)
 #define UART3           ((LPC_UART_TypeDef *)LPC_UART3)
 
+// maximum size of a GPDMA transfer
+#define DMA_MAX_TRANSFER    0xFFF
+
 
 /*
 ************************************************************************************************************************
@@ -27,6 +36,14 @@
 ************************************************************************************************************************
 */
 
+static const uint8_t g_dma_rx_conn[SERIAL_MAX_INSTANCES] = {
+    GPDMA_CONN_UART0_Rx, GPDMA_CONN_UART1_Rx, GPDMA_CONN_UART2_Rx, GPDMA_CONN_UART3_Rx
+};
+
+static const uint8_t g_dma_tx_conn[SERIAL_MAX_INSTANCES] = {
+    GPDMA_CONN_UART0_Tx, GPDMA_CONN_UART1_Tx, GPDMA_CONN_UART2_Tx, GPDMA_CONN_UART3_Tx
+};
+
 
 /*
 ************************************************************************************************************************
@@ -46,6 +63,11 @@
                              (port) == 2 ? UART2 : \
                              (port) == 3 ? UART3 : 0)
 
+// GPDMA channels, the lower channels have higher priority so rx comes first
+#define DMA_RX_CHANNEL(s)   ((s)->uart_id)
+#define DMA_TX_CHANNEL(s)   ((s)->uart_id + 4)
+#define DMA_CHANNEL(ch)     ((LPC_GPDMACH_TypeDef *) (LPC_GPDMACH0_BASE + ((ch) * 0x20)))
+
 #ifdef OUTPUT_ENABLE_ACTIVE_IN_HIGH
 #define WRITE_MODE(s)   if (s->has_oe) {SET_PIN(s->oe_port, s->oe_pin); delay_us(OUTPUT_ENABLE_DELAY);}
 #define READ_MODE(s)    if (s->has_oe) CLR_PIN(s->oe_port, s->oe_pin);
@@ -63,6 +85,8 @@
 
 static serial_t *g_serial_instances[SERIAL_MAX_INSTANCES];
 static uint8_t g_init_instances = 0;
+static uint8_t g_dma_instances = 0;
+static xSemaphoreHandle g_tx_space_sem[SERIAL_MAX_INSTANCES];
 
 
 /*
@@ -85,16 +109,70 @@ static uint8_t g_init_instances = 0;
 ************************************************************************************************************************
 */
 
-static void uart_receive(serial_t *serial)
+// returns how many bytes the rx DMA wrote and were not read yet
+static uint32_t dma_rx_count(serial_t *serial)
 {
-    LPC_UART_TypeDef *uart = GET_UART(serial->uart_id);
+    uint32_t write = DMA_CHANNEL(DMA_RX_CHANNEL(serial))->CDestAddr - (uint32_t) serial->dma_rx_buffer;
+
+    // the channel may point to the buffer end before reloading the first half
+    write %= SERIAL_DMA_RX_BUFF_SIZE;
+
+    return ((write + SERIAL_DMA_RX_BUFF_SIZE - serial->dma_rx_read) % SERIAL_DMA_RX_BUFF_SIZE);
+}
+
+// reads the received data, from the FIFO or from the rx DMA buffer
+static uint32_t rx_read(serial_t *serial, uint8_t *data, uint32_t data_size)
+{
+    if (!serial->has_dma)
+        return UART_Receive(GET_UART(serial->uart_id), data, data_size, NONE_BLOCKING);
+
+    uint32_t count = dma_rx_count(serial);
+    if (count > data_size) count = data_size;
+
+    // copies up to the end of the buffer and then from its beginning
+    uint32_t first = SERIAL_DMA_RX_BUFF_SIZE - serial->dma_rx_read;
+    if (first > count) first = count;
+
+    memcpy(data, &serial->dma_rx_buffer[serial->dma_rx_read], first);
+    memcpy(&data[first], serial->dma_rx_buffer, count - first);
+
+    serial->dma_rx_read = (serial->dma_rx_read + count) % SERIAL_DMA_RX_BUFF_SIZE;
+
+    return count;
+}
+
+// locks out the interrupt which empties the tx buffer
+static void tx_interrupt(serial_t *serial, FunctionalState state)
+{
+    if (serial->has_dma)
+    {
+        if (state == ENABLE) NVIC_EnableIRQ(DMA_IRQn);
+        else NVIC_DisableIRQ(DMA_IRQn);
+    }
+    else
+    {
+        // the THRE interrupt is only on while the transmission is running
+        if (state == DISABLE || !serial->sof)
+            UART_IntConfig(GET_UART(serial->uart_id), UART_INTCFG_THRE, state);
+    }
+}
 
+// wakes up the tasks waiting for space in the tx buffer
+static void tx_space_available(serial_t *serial)
+{
+    portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+    xSemaphoreGiveFromISR(g_tx_space_sem[serial->uart_id], &xHigherPriorityTaskWoken);
+    portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+}
+
+static void uart_receive(serial_t *serial)
+{
     uint32_t count, written;
     uint8_t buffer[FIFO_TRIGGER];
 
     // reads from uart and puts on ring buffer
     // keeps one byte on FIFO to force CTI interrupt
-    count = UART_Receive(uart, buffer, FIFO_TRIGGER-1, NONE_BLOCKING);
+    count = rx_read(serial, buffer, FIFO_TRIGGER-1);
 
     // writes data to ring buffer
     written = ringbuff_write(serial->rx_buffer, buffer, count);
@@ -110,8 +188,217 @@ static void uart_receive(serial_t *serial)
     }
 }
 
+// returns the contiguous free space after the frames head
+// one byte is kept free to tell a full buffer from an empty one
+static uint32_t frames_space(serial_t *serial)
+{
+    uint32_t head = serial->rx_frames_head;
+    uint32_t tail = serial->rx_frames_tail;
+
+    if (head < tail) return (tail - head - 1);
+    if (tail == 0) return (serial->rx_frames_size - head - 1);
+    return (serial->rx_frames_size - head);
+}
+
+static void uart_receive_frames(serial_t *serial)
+{
+    uint8_t *frames = serial->rx_frames;
+
+    while (1)
+    {
+        uint32_t space = frames_space(serial);
+
+        if (space == 0)
+        {
+            uint32_t partial = serial->rx_frames_head - serial->rx_frames_start;
+
+            // moves the incomplete frame to the beginning of the buffer if it fits there
+            if (serial->rx_frames_head >= serial->rx_frames_tail && serial->rx_frames_tail > (partial + 1))
+            {
+                memmove(frames, &frames[serial->rx_frames_start], partial);
+                serial->rx_frames_start = 0;
+                serial->rx_frames_head = partial;
+            }
+            // no room for the frame, discards it until its terminator
+            else
+            {
+                serial->rx_frames_head = serial->rx_frames_start;
+                if (partial > 0) serial->rx_frames_overflow = 1;
+            }
+
+            space = frames_space(serial);
+        }
+
+        uint32_t count;
+
+        // buffer is full of frames not released yet, the received bytes are lost
+        if (space == 0)
+        {
+            uint8_t buffer[UART_TX_FIFO_SIZE];
+            count = rx_read(serial, buffer, UART_TX_FIFO_SIZE);
+            if (count == 0) break;
+
+            // the next frame is only complete if it starts after the lost bytes
+            serial->rx_frames_overflow = (buffer[count - 1] != 0);
+            continue;
+        }
+
+        // reads from uart straight to the frame
+        count = rx_read(serial, &frames[serial->rx_frames_head], space);
+        if (count == 0) break;
+
+        uint32_t pos = serial->rx_frames_head;
+        uint32_t end = pos + count;
+
+        // looks for the end of frames
+        while (pos < end)
+        {
+            if (frames[pos] != 0)
+            {
+                pos++;
+                continue;
+            }
+
+            uint32_t start = serial->rx_frames_start;
+            uint32_t frame_size = pos - start + 1;
+
+            if (!serial->rx_frames_overflow && serial->rx_frame_callback(serial, &frames[start], frame_size))
+            {
+                serial->rx_frames_start = pos + 1;
+                pos++;
+            }
+            else
+            {
+                // frame not accepted, the bytes after it take its place
+                uint32_t remaining = end - pos - 1;
+                memmove(&frames[start], &frames[pos + 1], remaining);
+                end = start + remaining;
+                pos = start;
+                serial->rx_frames_overflow = 0;
+            }
+        }
+
+        serial->rx_frames_head = end;
+    }
+}
+
+static void dma_receive(serial_t *serial)
+{
+    if (dma_rx_count(serial) == 0) return;
+
+    if (serial->rx_frames)
+    {
+        uart_receive_frames(serial);
+        return;
+    }
+
+    serial->eof = 0;
+    while (dma_rx_count(serial) > 0)
+        uart_receive(serial);
+
+    // the DMA is only processed after a pause or every half buffer
+    serial->eof = 1;
+    if (serial->rx_callback) serial->rx_callback(serial);
+}
+
+static void dma_rx_start(serial_t *serial)
+{
+    uint32_t half = SERIAL_DMA_RX_BUFF_SIZE / 2;
+    uint32_t src = (uint32_t) &(GET_UART(serial->uart_id)->RBR);
+    uint32_t control = GPDMA_DMACCxControl_TransferSize(half) |
+                       GPDMA_DMACCxControl_SBSize(GPDMA_BSIZE_1) | GPDMA_DMACCxControl_DBSize(GPDMA_BSIZE_1) |
+                       GPDMA_DMACCxControl_SWidth(GPDMA_WIDTH_BYTE) | GPDMA_DMACCxControl_DWidth(GPDMA_WIDTH_BYTE) |
+                       GPDMA_DMACCxControl_DI | GPDMA_DMACCxControl_I;
+
+    // the two halves are linked to each other, so the channel never stops
+    serial->dma_rx_lli[0].src = src;
+    serial->dma_rx_lli[0].dst = (uint32_t) serial->dma_rx_buffer;
+    serial->dma_rx_lli[0].next = (uint32_t) &serial->dma_rx_lli[1];
+    serial->dma_rx_lli[0].control = control;
+    serial->dma_rx_lli[1].src = src;
+    serial->dma_rx_lli[1].dst = (uint32_t) &serial->dma_rx_buffer[half];
+    serial->dma_rx_lli[1].next = (uint32_t) &serial->dma_rx_lli[0];
+    serial->dma_rx_lli[1].control = control;
+
+    GPDMA_Channel_CFG_Type dma_cfg;
+    dma_cfg.ChannelNum = DMA_RX_CHANNEL(serial);
+    dma_cfg.TransferSize = half;
+    dma_cfg.TransferWidth = 0;
+    dma_cfg.SrcMemAddr = 0;
+    dma_cfg.DstMemAddr = (uint32_t) serial->dma_rx_buffer;
+    dma_cfg.TransferType = GPDMA_TRANSFERTYPE_P2M;
+    dma_cfg.SrcConn = g_dma_rx_conn[serial->uart_id];
+    dma_cfg.DstConn = 0;
+    dma_cfg.DMALLI = (uint32_t) &serial->dma_rx_lli[1];
+
+    serial->dma_rx_read = 0;
+
+    GPDMA_Setup(&dma_cfg);
+    GPDMA_ChannelCmd(dma_cfg.ChannelNum, ENABLE);
+}
+
+// starts a transfer of the pending tx data, does nothing while a transfer is running
+// must be called with the DMA interrupt disabled or from it
+static void dma_transmit(serial_t *serial)
+{
+    uint32_t count;
+    uint8_t *data;
+
+    if (serial->dma_tx_count) return;
+
+    // sends the contiguous data up to the end of the ring buffer
+    count = ringbuff_peek_span(serial->tx_buffer, &data);
+
+    if (count == 0)
+    {
+        if (!serial->sof)
+        {
+            if (serial->has_oe)
+            {
+                while (UART_CheckBusy(GET_UART(serial->uart_id)) == SET);
+                READ_MODE(serial);
+            }
+
+            serial->sof = 1;
+        }
+
+        return;
+    }
+
+    if (count > DMA_MAX_TRANSFER) count = DMA_MAX_TRANSFER;
+
+    // if is start of frame checks whether OE is necessary
+    if (serial->sof)
+    {
+        WRITE_MODE(serial);
+        serial->sof = 0;
+    }
+
+    GPDMA_Channel_CFG_Type dma_cfg;
+    dma_cfg.ChannelNum = DMA_TX_CHANNEL(serial);
+    dma_cfg.TransferSize = count;
+    dma_cfg.TransferWidth = 0;
+    dma_cfg.SrcMemAddr = (uint32_t) data;
+    dma_cfg.DstMemAddr = 0;
+    dma_cfg.TransferType = GPDMA_TRANSFERTYPE_M2P;
+    dma_cfg.SrcConn = 0;
+    dma_cfg.DstConn = g_dma_tx_conn[serial->uart_id];
+    dma_cfg.DMALLI = 0;
+
+    serial->dma_tx_count = count;
+
+    GPDMA_Setup(&dma_cfg);
+    GPDMA_ChannelCmd(dma_cfg.ChannelNum, ENABLE);
+}
+
 static void uart_transmit(serial_t *serial)
 {
+    if (serial->has_dma)
+    {
+        dma_transmit(serial);
+        return;
+    }
+
     LPC_UART_TypeDef *uart = GET_UART(serial->uart_id);
 
     // Disable THRE interrupt
@@ -129,10 +416,13 @@ static void uart_transmit(serial_t *serial)
     }
 
     uint32_t count;
-    uint8_t buffer[UART_TX_FIFO_SIZE];
+    uint8_t *data;
 
-    count = ringbuff_read(serial->tx_buffer, buffer, UART_TX_FIFO_SIZE);
-    if (count > 0) UART_Send(uart, buffer, count, NONE_BLOCKING);
+    // sends straight from the ring buffer, the wrapped part goes on the next THRE interrupt
+    count = ringbuff_peek_span(serial->tx_buffer, &data);
+    if (count > UART_TX_FIFO_SIZE) count = UART_TX_FIFO_SIZE;
+    if (count > 0) UART_Send(uart, data, count, NONE_BLOCKING);
+    ringbuff_commit(serial->tx_buffer, count);
 
     // Enable THRE interrupt if buffer is not empty
     if (!ringbuff_is_empty(serial->tx_buffer))
@@ -176,6 +466,9 @@ static void uart_handler(serial_t *serial)
             {
                 uint8_t buffer[UART_TX_FIFO_SIZE];
                 UART_Receive(uart, buffer, UART_TX_FIFO_SIZE, NONE_BLOCKING);
+
+                // the frame being received lost some bytes
+                serial->rx_frames_overflow = 1;
             }
 
             serial_error(serial->uart_id, status);
@@ -186,6 +479,13 @@ static void uart_handler(serial_t *serial)
     // Receive Data Available or Character time-out
     if ((tmp == UART_IIR_INTID_RDA) || (tmp == UART_IIR_INTID_CTI))
     {
+        // frame mode
+        if (serial->rx_frames)
+        {
+            uart_receive_frames(serial);
+            return;
+        }
+
         serial->eof = 0;
         uart_receive(serial);
 
@@ -201,6 +501,7 @@ static void uart_handler(serial_t *serial)
     if (tmp == UART_IIR_INTID_THRE)
     {
         uart_transmit(serial);
+        tx_space_available(serial);
     }
 }
 
@@ -297,6 +598,27 @@ void serial_init(serial_t *serial)
     UARTFIFOConfigStruct.FIFO_Level = UART_FIFO_TRGLEV3;
     #endif
 
+    // the FIFO requests the DMA instead of interrupting
+    // falls back to the interrupt mode if the rx DMA buffer can't be allocated
+    if (serial->has_dma)
+    {
+        serial->dma_rx_buffer = (uint8_t *) MALLOC(SERIAL_DMA_RX_BUFF_SIZE);
+        serial->dma_tx_count = 0;
+
+        if (serial->dma_rx_buffer)
+        {
+            // initializes the controller once
+            if (!g_dma_instances) GPDMA_Init();
+            g_dma_instances++;
+
+            UARTFIFOConfigStruct.FIFO_DMAMode = ENABLE;
+        }
+        else
+        {
+            serial->has_dma = 0;
+        }
+    }
+
     // Initialize FIFO for UART peripheral
     UART_FIFOConfig(uart, &UARTFIFOConfigStruct);
 
@@ -304,8 +626,16 @@ void serial_init(serial_t *serial)
     serial->rx_buffer = ringbuff_create(serial->rx_buffer_size + 1);
     serial->tx_buffer = ringbuff_create(serial->tx_buffer_size + 1);
 
+    // given every time the transmission frees space in the tx buffer
+    vSemaphoreCreateBinary(g_tx_space_sem[serial->uart_id]);
+    // vSemaphoreCreateBinary is created as available which makes
+    // first xSemaphoreTake pass even if semaphore has not been given
+    xSemaphoreTake(g_tx_space_sem[serial->uart_id], 0);
+
     // initializes struct vars
     serial->rx_callback = 0;
+    serial->rx_frame_callback = 0;
+    serial->rx_frames = 0;
     serial->sof = 1;
     serial->eof = 0;
 
@@ -352,11 +682,26 @@ void serial_enable_interupt(serial_t *serial)
     ringbuff_flush(serial->rx_buffer);
     ringbuff_flush(serial->tx_buffer);
 
+    serial->rx_frames_head = 0;
+    serial->rx_frames_start = 0;
+    serial->rx_frames_tail = 0;
+    serial->rx_frames_overflow = 0;
+
     // Enable UART Transmit
     UART_TxCmd(uart, ENABLE);
 
-    // Enable UART Rx interrupt
-    UART_IntConfig(uart, UART_INTCFG_RBR, ENABLE);
+    if (serial->has_dma)
+    {
+        dma_rx_start(serial);
+
+        NVIC_SetPriority(DMA_IRQn, SERIAL_DMA_PRIORITY);
+        NVIC_EnableIRQ(DMA_IRQn);
+    }
+    else
+    {
+        // Enable UART Rx interrupt
+        UART_IntConfig(uart, UART_INTCFG_RBR, ENABLE);
+    }
 
     // Enable UART line status interrupt
     UART_IntConfig(uart, UART_INTCFG_RLS, ENABLE);
@@ -370,77 +715,79 @@ void serial_enable_interupt(serial_t *serial)
 
 uint32_t serial_send(uint8_t uart_id, const uint8_t *data, uint32_t data_size)
 {
-    LPC_UART_TypeDef *uart = GET_UART(uart_id);
+    return serial_send_timeout(uart_id, data, data_size, portMAX_DELAY);
+}
+
+uint32_t serial_send_timeout(uint8_t uart_id, const uint8_t *data, uint32_t data_size, uint32_t timeout)
+{
     serial_t *serial = g_serial_instances[uart_id];
 
     if (!serial) return 0;
 
-    // Temporarily lock out UART transmit interrupts during this
-    // read so the UART transmit interrupt won't cause problems
-    // with the index values
-    UART_IntConfig(uart, UART_INTCFG_THRE, DISABLE);
+    uint32_t written, index = 0;
+    portTickType start = xTaskGetTickCount();
 
-    uint32_t written, to_write, index;
-    written = ringbuff_write(serial->tx_buffer, data, data_size);
-    to_write = data_size - written;
-    index = written;
+    while (index < data_size)
+    {
+        if (ringbuff_is_full(serial->tx_buffer))
+        {
+            // before the scheduler starts there is nothing to sleep on
+            if (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING)
+                continue;
 
-    uart_transmit(serial);
+            portTickType elapsed = xTaskGetTickCount() - start;
 
-    // waits until all data be sent
-    while (to_write > 0)
-    {
-        if (!ringbuff_is_full(serial->tx_buffer))
+            if (timeout != portMAX_DELAY)
+            {
+                if (elapsed >= timeout) break;
+                elapsed = timeout - elapsed;
+            }
+            else
+            {
+                elapsed = portMAX_DELAY;
+            }
+
+            // sleeps until the interrupt frees some space
+            xSemaphoreTake(g_tx_space_sem[uart_id], elapsed);
+            continue;
+        }
+
+        // the interrupt only moves the tail, so the data is written without locking it out
+        written = ringbuff_write(serial->tx_buffer, &data[index], data_size - index);
+        index += written;
+
+        // starts the transmission if the interrupts already emptied the buffer
+        // the data is published before sof is checked, so either the interrupt sends it
+        // or it has already set sof
+        if (serial->sof)
         {
-            written = ringbuff_write(serial->tx_buffer, &data[index], to_write);
-            to_write -= written;
-            index += written;
+            tx_interrupt(serial, DISABLE);
+            if (serial->sof) uart_transmit(serial);
+            tx_interrupt(serial, ENABLE);
         }
     }
 
-    return data_size;
+    return index;
 }
 
 uint32_t serial_read(uint8_t uart_id, uint8_t *data, uint32_t data_size)
 {
-    LPC_UART_TypeDef *uart = GET_UART(uart_id);
     serial_t *serial = g_serial_instances[uart_id];
 
     if (!serial) return 0;
 
-    // Temporarily lock out UART receive interrupts during this
-    // read so the UART receive interrupt won't cause problems
-    // with the index values
-    UART_IntConfig(uart, UART_INTCFG_RBR, DISABLE);
-
-    uint32_t count;
-    count = ringbuff_read(serial->rx_buffer, data, data_size);
-
-    // Re-enable UART interrupts
-    UART_IntConfig(uart, UART_INTCFG_RBR, ENABLE);
-
-    return count;
+    // the ring buffer is safe to read while the interrupt fills it
+    return ringbuff_read(serial->rx_buffer, data, data_size);
 }
 
 uint32_t serial_read_until(uint8_t uart_id, uint8_t *data, uint32_t data_size, uint8_t token)
 {
-    LPC_UART_TypeDef *uart = GET_UART(uart_id);
     serial_t *serial = g_serial_instances[uart_id];
 
     if (!serial) return 0;
 
-    // Temporarily lock out UART receive interrupts during this
-    // read so the UART receive interrupt won't cause problems
-    // with the index values
-    UART_IntConfig(uart, UART_INTCFG_RBR, DISABLE);
-
-    uint32_t count;
-    count = ringbuff_read_until(serial->rx_buffer, data, data_size, token);
-
-    // Re-enable UART interrupts
-    UART_IntConfig(uart, UART_INTCFG_RBR, ENABLE);
-
-    return count;
+    // the ring buffer is safe to read while the interrupt fills it
+    return ringbuff_read_until(serial->rx_buffer, data, data_size, token);
 }
 
 void serial_set_callback(uint8_t uart_id, void (*receive_cb)(serial_t *serial))
@@ -451,6 +798,52 @@ void serial_set_callback(uint8_t uart_id, void (*receive_cb)(serial_t *serial))
     }
 }
 
+uint8_t serial_set_rx_delimiter(uint8_t uart_id, uint8_t delimiter, uint32_t max_count)
+{
+    serial_t *serial = g_serial_instances[uart_id];
+
+    if (!serial) return 0;
+
+    return ringbuff_set_delimiter(serial->rx_buffer, delimiter, max_count);
+}
+
+uint8_t serial_set_frame_callback(uint8_t uart_id, uint32_t buffer_size,
+                                  uint8_t (*frame_cb)(serial_t *serial, uint8_t *frame, uint32_t frame_size))
+{
+    serial_t *serial = g_serial_instances[uart_id];
+
+    if (!serial) return 0;
+
+    uint8_t *frames = (uint8_t *) MALLOC(buffer_size);
+    if (!frames) return 0;
+
+    serial->rx_frames_size = buffer_size;
+    serial->rx_frames_head = 0;
+    serial->rx_frames_start = 0;
+    serial->rx_frames_tail = 0;
+    serial->rx_frames_overflow = 0;
+    serial->rx_frame_callback = frame_cb;
+    serial->rx_frames = frames;
+
+    return 1;
+}
+
+void serial_release_frame(uint8_t uart_id, const uint8_t *frame, uint32_t frame_size)
+{
+    serial_t *serial = g_serial_instances[uart_id];
+
+    if (!serial || !serial->rx_frames) return;
+
+    // the space up to the end of the frame can be reused by the interrupt
+    serial->rx_frames_tail = (frame - serial->rx_frames) + frame_size;
+}
+
+void serial_dma_poll(void)
+{
+    // the received data is processed by the DMA interrupt
+    if (g_dma_instances) NVIC_SetPendingIRQ(DMA_IRQn);
+}
+
 void serial_flush_tx_buffer(uint8_t uart_id)
 {
     serial_t *serial = g_serial_instances[uart_id];
@@ -477,3 +870,37 @@ void UART3_IRQHandler(void)
 {
     uart_handler(g_serial_instances[3]);
 }
+
+void DMA_IRQHandler(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < SERIAL_MAX_INSTANCES; i++)
+    {
+        serial_t *serial = g_serial_instances[i];
+
+        if (!serial || !serial->has_dma) continue;
+
+        // tx transfer done, releases the sent data and starts the next transfer
+        uint8_t channel = DMA_TX_CHANNEL(serial);
+        if (LPC_GPDMA->IntTCStat & GPDMA_DMACIntTCStat_Ch(channel))
+        {
+            LPC_GPDMA->IntTCClear = GPDMA_DMACIntTCClear_Ch(channel);
+
+            ringbuff_commit(serial->tx_buffer, serial->dma_tx_count);
+            serial->dma_tx_count = 0;
+            dma_transmit(serial);
+            tx_space_available(serial);
+        }
+
+        // half rx buffer done or polled, the rx channel runs since the interrupts were enabled
+        channel = DMA_RX_CHANNEL(serial);
+        if (LPC_GPDMA->EnbldChns & GPDMA_DMACEnbldChns_Ch(channel))
+        {
+            LPC_GPDMA->IntTCClear = GPDMA_DMACIntTCClear_Ch(channel);
+            dma_receive(serial);
+        }
+    }
+
+    LPC_GPDMA->IntErrClr = GPDMA_DMACIntErrClr_BITMASK;
+}
@@ -6,11 +6,13 @@
 */
 
 #include <string.h>
+#include "sys_comm.h"
 #include "config.h"
 #include "serial.h"
 
 #include "FreeRTOS.h"
 #include "semphr.h"
+#include "queue.h"
 
 #include "mod-protocol.h"
 
@@ -20,7 +22,7 @@
 ************************************************************************************************************************
 */
 
-#define SYSTEM_MAX_SEM_COUNT   10
+#define SYSTEM_MAX_FRAMES       10
 
 
 /*
@@ -36,6 +38,12 @@
 ************************************************************************************************************************
 */
 
+// received message, stays in the serial frame buffer until released
+typedef struct SYSTEM_FRAME_T {
+    char *data;
+    uint32_t size;
+} system_frame_t;
+
 
 /*
 ************************************************************************************************************************
@@ -53,8 +61,8 @@
 static  void (*g_system_response_cb)(void *data, menu_item_t *item) = NULL;
 static  menu_item_t *g_current_item;
 static volatile uint8_t  g_system_blocked;
-static volatile xSemaphoreHandle g_system_sem = NULL;
-static  ringbuff_t *g_system_rx_rb;
+static xQueueHandle g_system_frames = NULL;
+static volatile uint32_t g_system_discard;
 
 
 /*
@@ -77,27 +85,18 @@ static  ringbuff_t *g_system_rx_rb;
 ************************************************************************************************************************
 */
 
-static void system_rx_cb(serial_t *serial)
+static uint8_t system_frame_cb(serial_t *serial, uint8_t *frame, uint32_t frame_size)
 {
-    uint8_t buffer[SERIAL_MAX_RX_BUFF_SIZE] = {};
-    uint32_t size = serial_read(serial->uart_id, buffer, sizeof(buffer));
-    if (size > 0)
-    {
-        ringbuff_write(g_system_rx_rb, buffer, size);
-        // check end of message
-        uint32_t i;
-        for (i = 0; i < size; i++)
-        {
-            if (buffer[i] == 0)
-            {
-                portBASE_TYPE xHigherPriorityTaskWoken;
-                xHigherPriorityTaskWoken = pdFALSE;
-                xSemaphoreGiveFromISR(g_system_sem, &xHigherPriorityTaskWoken);
-                portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
-                break;
-            }
-        }
-    }
+    (void) serial;
+
+    system_frame_t msg = {(char *) frame, frame_size};
+    portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+    if (xQueueSendToBackFromISR(g_system_frames, &msg, &xHigherPriorityTaskWoken) != pdTRUE)
+        return 0;
+
+    portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+    return 1;
 }
 
 
@@ -109,10 +108,9 @@ static void system_rx_cb(serial_t *serial)
 
 void sys_comm_init(void)
 {
-    g_system_sem = xSemaphoreCreateCounting(SYSTEM_MAX_SEM_COUNT, 0);
-    g_system_rx_rb = ringbuff_create(SYSTEM_COMM_RX_BUFF_SIZE);
+    g_system_frames = xQueueCreate(SYSTEM_MAX_FRAMES, sizeof(system_frame_t));
 
-    serial_set_callback(SYSTEM_SERIAL, system_rx_cb);
+    serial_set_frame_callback(SYSTEM_SERIAL, SYSTEM_COMM_RX_BUFF_SIZE, system_frame_cb);
 }
 
 void sys_comm_send(const char *command, const char *arguments)
@@ -146,16 +144,33 @@ void sys_comm_send(const char *command, const char *arguments)
     serial_send(SYSTEM_SERIAL, (const uint8_t*)buffer, data_size+1);
 }
 
-ringbuff_t* sys_comm_read(void)
+char* sys_comm_read(uint32_t *msg_size)
 {
-    if (xSemaphoreTake(g_system_sem, portMAX_DELAY) == pdTRUE)
+    system_frame_t msg;
+
+    while (xQueueReceive(g_system_frames, &msg, portMAX_DELAY) == pdTRUE)
     {
-        return g_system_rx_rb;
+        // message received before the last clear
+        if (g_system_discard > 0)
+        {
+            g_system_discard--;
+            sys_comm_release(msg.data, msg.size);
+            continue;
+        }
+
+        *msg_size = msg.size;
+        return msg.data;
     }
 
+    *msg_size = 0;
     return NULL;
 }
 
+void sys_comm_release(const char *msg, uint32_t msg_size)
+{
+    serial_release_frame(SYSTEM_SERIAL, (const uint8_t*)msg, msg_size);
+}
+
 void sys_comm_set_response_cb(void (*resp_cb)(void *data, menu_item_t *item), menu_item_t *item)
 {
     g_current_item = item;
@@ -179,8 +194,8 @@ void sys_comm_wait_response(void)
     while (g_system_blocked);
 }
 
-//clear the ringbuffer
+//drops the received messages not read yet
 void sys_comm_clear(void)
 {
-    ringbuff_flush(g_system_rx_rb);
+    g_system_discard = uxQueueMessagesWaiting(g_system_frames);
 }
@@ -12,7 +12,9 @@
 #include "serial.h"
 
 #include "FreeRTOS.h"
+#include "task.h"
 #include "semphr.h"
+#include "queue.h"
 
 /*
 ************************************************************************************************************************
@@ -20,7 +22,7 @@
 ************************************************************************************************************************
 */
 
-#define WEBGUI_MAX_SEM_COUNT   5
+#define WEBGUI_MAX_FRAMES       16
 
 
 /*
@@ -36,6 +38,18 @@
 ************************************************************************************************************************
 */
 
+// received message, stays in the serial frame buffer until released
+typedef struct WEBGUI_FRAME_T {
+    char *data;
+    uint32_t size;
+} webgui_frame_t;
+
+// pipelined request waiting for its webgui response
+typedef struct WEBGUI_REQUEST_T {
+    void (*callback)(void *data, void *arg);
+    void *arg;
+} webgui_request_t;
+
 
 /*
 ************************************************************************************************************************
@@ -53,8 +67,15 @@
 static  void (*g_webgui_response_cb)(void *data, menu_item_t *item) = NULL;
 static  menu_item_t *g_current_item;
 static volatile uint8_t  g_webgui_blocked;
-static volatile xSemaphoreHandle g_webgui_sem = NULL;
-static  ringbuff_t *g_webgui_rx_rb;
+static xQueueHandle g_webgui_frames = NULL;
+static volatile uint32_t g_webgui_discard;
+static xTaskHandle g_webgui_reader = NULL;
+
+// outstanding pipelined requests, completed in the order they were sent
+static webgui_request_t g_webgui_requests[WEBGUI_MAX_PENDING_REQUESTS];
+static volatile uint8_t g_webgui_req_head, g_webgui_req_tail, g_webgui_req_count;
+static xSemaphoreHandle g_webgui_req_slots_sem = NULL;
+static xSemaphoreHandle g_webgui_resp_sem = NULL;
 
 
 /*
@@ -77,27 +98,47 @@ static  ringbuff_t *g_webgui_rx_rb;
 ************************************************************************************************************************
 */
 
-static void webgui_rx_cb(serial_t *serial)
+// waits (without spinning) until the outstanding requests got their responses
+static void webgui_wait_requests(void)
 {
-    uint8_t buffer[SERIAL_MAX_RX_BUFF_SIZE] = {};
-    uint32_t size = serial_read(serial->uart_id, buffer, sizeof(buffer));
-    if (size > 0)
-    {
-        ringbuff_write(g_webgui_rx_rb, buffer, size);
-        // check end of message
-        uint32_t i;
-        for (i = 0; i < size; i++)
-        {
-            if (buffer[i] == 0)
-            {
-                portBASE_TYPE xHigherPriorityTaskWoken;
-                xHigherPriorityTaskWoken = pdFALSE;
-                xSemaphoreGiveFromISR(g_webgui_sem, &xHigherPriorityTaskWoken);
-                portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
-                break;
-            }
-        }
-    }
+    // the reader task completes the requests, it can not wait for itself
+    if (xTaskGetCurrentTaskHandle() == g_webgui_reader)
+        return;
+
+    // a short timeout makes sure every waiting task re-checks the count
+    while (g_webgui_req_count > 0)
+        xSemaphoreTake(g_webgui_resp_sem, 1);
+}
+
+static void webgui_drop_requests(void)
+{
+    uint8_t dropped;
+
+    taskENTER_CRITICAL();
+    dropped = g_webgui_req_count;
+    g_webgui_req_head = 0;
+    g_webgui_req_tail = 0;
+    g_webgui_req_count = 0;
+    taskEXIT_CRITICAL();
+
+    while (dropped--)
+        xSemaphoreGive(g_webgui_req_slots_sem);
+
+    xSemaphoreGive(g_webgui_resp_sem);
+}
+
+static uint8_t webgui_frame_cb(serial_t *serial, uint8_t *frame, uint32_t frame_size)
+{
+    (void) serial;
+
+    webgui_frame_t msg = {(char *) frame, frame_size};
+    portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+    if (xQueueSendToBackFromISR(g_webgui_frames, &msg, &xHigherPriorityTaskWoken) != pdTRUE)
+        return 0;
+
+    portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+    return 1;
 }
 
 
@@ -109,27 +150,80 @@ static void webgui_rx_cb(serial_t *serial)
 
 void ui_comm_init(void)
 {
-    g_webgui_sem = xSemaphoreCreateCounting(WEBGUI_MAX_SEM_COUNT, 0);
-    g_webgui_rx_rb = ringbuff_create(WEBGUI_COMM_RX_BUFF_SIZE);
+    g_webgui_frames = xQueueCreate(WEBGUI_MAX_FRAMES, sizeof(webgui_frame_t));
+
+    g_webgui_req_slots_sem = xSemaphoreCreateCounting(WEBGUI_MAX_PENDING_REQUESTS, WEBGUI_MAX_PENDING_REQUESTS);
+    vSemaphoreCreateBinary(g_webgui_resp_sem);
+    // vSemaphoreCreateBinary is created as available which makes
+    // first xSemaphoreTake pass even if semaphore has not been given
+    xSemaphoreTake(g_webgui_resp_sem, 0);
 
-    serial_set_callback(WEBGUI_SERIAL, webgui_rx_cb);
+    // room for the message being parsed while the next ones are received
+    serial_set_frame_callback(WEBGUI_SERIAL, 2 * WEBGUI_COMM_RX_BUFF_SIZE, webgui_frame_cb);
 }
 
 void ui_comm_webgui_send(const char *data, uint32_t data_size)
 {
+    // keeps the messages ordered, the pipelined requests are answered first
+    webgui_wait_requests();
+
+    serial_send(WEBGUI_SERIAL, (const uint8_t*)data, data_size+1);
+}
+
+void ui_comm_webgui_send_request(const char *data, uint32_t data_size, void (*req_cb)(void *data, void *arg), void *arg)
+{
+    // a blocking request is still waiting for its response
+    while (g_webgui_blocked)
+        xSemaphoreTake(g_webgui_resp_sem, 1);
+
+    // only blocks when the pipeline is full
+    xSemaphoreTake(g_webgui_req_slots_sem, portMAX_DELAY);
+
+    // the request must be tracked before the response can arrive
+    taskENTER_CRITICAL();
+    g_webgui_requests[g_webgui_req_head].callback = req_cb;
+    g_webgui_requests[g_webgui_req_head].arg = arg;
+    g_webgui_req_head = (g_webgui_req_head + 1) % WEBGUI_MAX_PENDING_REQUESTS;
+    g_webgui_req_count++;
+    taskEXIT_CRITICAL();
+
     serial_send(WEBGUI_SERIAL, (const uint8_t*)data, data_size+1);
 }
 
-ringbuff_t* ui_comm_webgui_read(void)
+uint8_t ui_comm_webgui_pending_requests(void)
 {
-    if (xSemaphoreTake(g_webgui_sem, portMAX_DELAY) == pdTRUE)
+    return g_webgui_req_count;
+}
+
+char* ui_comm_webgui_read(uint32_t *msg_size)
+{
+    webgui_frame_t msg;
+
+    g_webgui_reader = xTaskGetCurrentTaskHandle();
+
+    while (xQueueReceive(g_webgui_frames, &msg, portMAX_DELAY) == pdTRUE)
     {
-        return g_webgui_rx_rb;
+        // message received before the last clear
+        if (g_webgui_discard > 0)
+        {
+            g_webgui_discard--;
+            ui_comm_webgui_release(msg.data, msg.size);
+            continue;
+        }
+
+        *msg_size = msg.size;
+        return msg.data;
     }
 
+    *msg_size = 0;
     return NULL;
 }
 
+void ui_comm_webgui_release(const char *msg, uint32_t msg_size)
+{
+    serial_release_frame(WEBGUI_SERIAL, (const uint8_t*)msg, msg_size);
+}
+
 void ui_comm_webgui_set_response_cb(void (*resp_cb)(void *data, menu_item_t *item), menu_item_t *item)
 {
     g_current_item = item;
@@ -138,6 +232,23 @@ void ui_comm_webgui_set_response_cb(void (*resp_cb)(void *data, menu_item_t *ite
 
 void ui_comm_webgui_response_cb(void *data)
 {
+    // mod-ui answers in order, so the oldest pipelined request owns this response
+    if (g_webgui_req_count > 0)
+    {
+        webgui_request_t *request = &g_webgui_requests[g_webgui_req_tail];
+        if (request->callback)
+            request->callback(data, request->arg);
+
+        taskENTER_CRITICAL();
+        g_webgui_req_tail = (g_webgui_req_tail + 1) % WEBGUI_MAX_PENDING_REQUESTS;
+        g_webgui_req_count--;
+        taskEXIT_CRITICAL();
+
+        xSemaphoreGive(g_webgui_req_slots_sem);
+        xSemaphoreGive(g_webgui_resp_sem);
+        return;
+    }
+
     if (g_webgui_response_cb)
     {
         g_webgui_response_cb(data, g_current_item);
@@ -145,18 +256,26 @@ void ui_comm_webgui_response_cb(void *data)
     }
 
     g_webgui_blocked = 0;
+    xSemaphoreGive(g_webgui_resp_sem);
 }
 
 void ui_comm_webgui_wait_response(void)
 {
     g_webgui_blocked = 1;
-    while (g_webgui_blocked);
+
+    // sleeps instead of spinning so lower priority tasks keep running
+    while (g_webgui_blocked)
+        xSemaphoreTake(g_webgui_resp_sem, 1);
 }
 
-//clear the ringbuffer
+//drops the received messages not read yet
 void ui_comm_webgui_clear(void)
 {
-    ringbuff_flush(g_webgui_rx_rb);
+    // the message being parsed is owned by the reader, so the queued ones are skipped when read
+    g_webgui_discard = uxQueueMessagesWaiting(g_webgui_frames);
+
+    // the responses of the pipelined requests are gone with the messages
+    webgui_drop_requests();
 }
 
 //clear the ringbuffer
@@ -14,6 +14,7 @@
 #include "cli.h"
 #include "screen.h"
 #include "hardware.h"
+#include "LPC177x_8x.h"
 
 /*
 ************************************************************************************************************************
@@ -42,9 +43,16 @@
 ************************************************************************************************************************
 */
 
-#define BUFFER_IS_FULL(rb)      (rb->tail == (rb->head + 1) % rb->size)
+// the ring buffer size is a power of two, so the indexes wrap with a mask
+#define BUFFER_IS_FULL(rb)      (rb->tail == ((rb->head + 1) & rb->mask))
 #define BUFFER_IS_EMPTY(rb)     (rb->head == rb->tail)
-#define BUFFER_INC(rb,idx)      (rb->idx = (rb->idx + 1) % rb->size)
+#define BUFFER_INC(rb,idx)      (rb->idx = (rb->idx + 1) & rb->mask)
+#define BUFFER_USED(rb)         ((rb->head - rb->tail) & rb->mask)
+
+// the ring buffer is shared by one producer and one consumer, usually an interrupt and a task,
+// so each side only writes its own index and publishes it after the data it refers to
+#define BUFFER_BARRIER()        __DMB()
+#define BUFFER_INDEXED(rb,tk)   (rb->delimiters && !rb->delimiters_overflow && rb->delimiter == (tk))
 
 
 /*
@@ -74,6 +82,52 @@
 ************************************************************************************************************************
 */
 
+// records the position of a delimiter written to the ring buffer (producer side)
+static void delimiters_push(ringbuff_t *rb, uint32_t position)
+{
+    uint32_t head = rb->delimiters_head;
+
+    // after an overflow the index only keeps the oldest delimiters, it is used again
+    // when the buffer gets empty (see ringbuff_write)
+    if (rb->delimiters_overflow) return;
+
+    if (head - rb->delimiters_tail == rb->delimiters_size)
+    {
+        rb->delimiters_overflow = 1;
+        return;
+    }
+
+    rb->delimiters[head % rb->delimiters_size] = position;
+    BUFFER_BARRIER();
+    rb->delimiters_head = head + 1;
+}
+
+// returns the position of the oldest delimiter not read yet (consumer side)
+static uint32_t delimiters_first(ringbuff_t *rb)
+{
+    return rb->delimiters[rb->delimiters_tail % rb->delimiters_size];
+}
+
+// forgets the delimiters read (consumer side)
+// must be called before the tail is moved count bytes, otherwise the producer may
+// reuse the space and the new delimiters would be forgotten as well
+static void delimiters_drop(ringbuff_t *rb, uint32_t old_tail, uint32_t count)
+{
+    if (!rb->delimiters) return;
+
+    uint32_t tail = rb->delimiters_tail;
+
+    while (tail != rb->delimiters_head)
+    {
+        uint32_t distance = (rb->delimiters[tail % rb->delimiters_size] - old_tail) & rb->mask;
+        if (distance >= count) break;
+
+        tail++;
+    }
+
+    rb->delimiters_tail = tail;
+}
+
 static char* reverse(char* str, uint32_t str_len)
 {
     char *end = str + (str_len - 1);
@@ -203,6 +257,56 @@ char** strarr_split(char *str, const char token)
     return list;
 }
 
+int32_t strarr_split_into(char *str, const char token, char **list, uint32_t list_size)
+{
+    uint32_t count;
+    char *pstr;
+    uint8_t quote = 0;
+
+    // needs room at least for one token and the NULL terminator
+    if (!str || !list || list_size < 2) return -1;
+
+    // fill the list pointers
+    pstr = str;
+    list[0] = pstr;
+    count = 0;
+    while (*pstr)
+    {
+        if (*pstr == token && quote == 0)
+        {
+            // no room left for this token and the NULL terminator
+            if ((count + 2) >= list_size)
+            {
+                list[0] = NULL;
+                return -1;
+            }
+
+            *pstr = '\0';
+            list[++count] = pstr + 1;
+        }
+#ifdef ENABLE_QUOTATION_MARKS
+        if (*pstr == '"')
+        {
+            if (quote == 0) quote = 1;
+            else
+            {
+                if (*(pstr+1) == '"') pstr++;
+                else quote = 0;
+            }
+        }
+#endif
+        pstr++;
+    }
+
+    list[++count] = NULL;
+
+#ifdef ENABLE_QUOTATION_MARKS
+    uint32_t i = 0;
+    while (list[i]) parse_quote(list[i++]);
+#endif
+
+    return count;
+}
 
 uint32_t strarr_length(char** const str_array)
 {
@@ -527,12 +631,22 @@ ringbuff_t *ringbuff_create(uint32_t buffer_size)
 {
     ringbuff_t *rb = (ringbuff_t *) MALLOC(sizeof(ringbuff_t));
 
+    // rounds the size up to the next power of two
+    uint32_t size = 1;
+    while (size < buffer_size) size <<= 1;
+
     if (rb)
     {
         rb->head = 0;
         rb->tail = 0;
-        rb->size = buffer_size;
-        rb->buffer = (uint8_t *) MALLOC(buffer_size);
+        rb->size = size;
+        rb->mask = size - 1;
+        rb->buffer = (uint8_t *) MALLOC(size);
+        rb->delimiters = NULL;
+        rb->delimiters_size = 0;
+        rb->delimiters_head = 0;
+        rb->delimiters_tail = 0;
+        rb->delimiters_overflow = 0;
 
         // checks memory allocation
         if (!rb->buffer)
@@ -552,51 +666,126 @@ void ringbuff_destroy(ringbuff_t *rb)
         if (rb->buffer)
             FREE(rb->buffer);
 
+        FREE(rb->delimiters);
         FREE(rb);
     }
 }
 
+uint8_t ringbuff_set_delimiter(ringbuff_t *rb, uint8_t delimiter, uint32_t max_count)
+{
+    uint32_t *delimiters = (uint32_t *) MALLOC(max_count * sizeof(uint32_t));
+    if (!delimiters) return 0;
+
+    FREE(rb->delimiters);
+
+    rb->delimiter = delimiter;
+    rb->delimiters_size = max_count;
+    rb->delimiters_head = 0;
+    rb->delimiters_tail = 0;
+
+    // the delimiters already in the buffer are unknown
+    rb->delimiters_overflow = !BUFFER_IS_EMPTY(rb);
+    rb->delimiters = delimiters;
+
+    return 1;
+}
+
 uint32_t ringbuff_write(ringbuff_t *rb, const uint8_t *data, uint32_t data_size)
 {
-    uint32_t bytes = 0;
-    const uint8_t *pdata, dummy = 0;
+    uint32_t head = rb->head, tail = rb->tail, first, i;
+
+    // the index is complete again once all data and delimiters before the overflow were read
+    if (rb->delimiters_overflow && head == tail && rb->delimiters_tail == rb->delimiters_head)
+        rb->delimiters_overflow = 0;
+
+    // one byte is kept free to tell a full buffer from an empty one
+    uint32_t available = (tail - head - 1) & rb->mask;
+    if (data_size > available) data_size = available;
+
+    // copies up to the end of the buffer and then from its beginning
+    first = rb->size - head;
+    if (first > data_size) first = data_size;
 
-    pdata =  data ? data : &dummy;
-    while (data_size > 0 && !BUFFER_IS_FULL(rb))
+    if (data)
     {
-        rb->buffer[rb->head] = *pdata;
-        if (data) pdata++;
-        BUFFER_INC(rb, head);
+        memcpy(&rb->buffer[head], data, first);
+        memcpy(rb->buffer, &data[first], data_size - first);
 
-        data_size--;
-        bytes++;
+        if (rb->delimiters)
+        {
+            for (i = 0; i < data_size; i++)
+            {
+                if (data[i] == rb->delimiter) delimiters_push(rb, (head + i) & rb->mask);
+            }
+        }
     }
+    else
+    {
+        memset(&rb->buffer[head], 0, first);
+        memset(rb->buffer, 0, data_size - first);
 
-    return bytes;
+        if (rb->delimiters && rb->delimiter == 0)
+        {
+            for (i = 0; i < data_size; i++) delimiters_push(rb, (head + i) & rb->mask);
+        }
+    }
+
+    // the head only moves after the data and its delimiters are in place
+    BUFFER_BARRIER();
+    rb->head = (head + data_size) & rb->mask;
+
+    return data_size;
 }
 
 uint32_t ringbuff_read(ringbuff_t *rb, uint8_t *buffer, uint32_t buffer_size)
 {
-    uint32_t bytes = 0;
-    uint8_t *data = buffer;
+    uint32_t tail = rb->tail, used = BUFFER_USED(rb);
 
-    while (buffer_size > 0 && !BUFFER_IS_EMPTY(rb))
-    {
-        if (buffer)
-            *data++ = rb->buffer[rb->tail];
+    if (buffer_size > used) buffer_size = used;
 
-        BUFFER_INC(rb, tail);
+    if (buffer)
+    {
+        // copies up to the end of the buffer and then from its beginning
+        uint32_t first = rb->size - tail;
+        if (first > buffer_size) first = buffer_size;
 
-        buffer_size--;
-        bytes++;
+        BUFFER_BARRIER();
+        memcpy(buffer, &rb->buffer[tail], first);
+        memcpy(&buffer[first], rb->buffer, buffer_size - first);
     }
 
-    return bytes;
+    ringbuff_commit(rb, buffer_size);
+
+    return buffer_size;
+}
+
+uint32_t ringbuff_peek_span(ringbuff_t *rb, uint8_t **data)
+{
+    uint32_t tail = rb->tail, head = rb->head;
+
+    *data = &rb->buffer[tail];
+    BUFFER_BARRIER();
+
+    // unread data up to the head or to the end of the buffer
+    if (head >= tail) return (head - tail);
+    return (rb->size - tail);
+}
+
+void ringbuff_commit(ringbuff_t *rb, uint32_t count)
+{
+    uint32_t tail = rb->tail, used = BUFFER_USED(rb);
+
+    if (count > used) count = used;
+
+    // the space is only given back to the producer after the data was used
+    delimiters_drop(rb, tail, count);
+    BUFFER_BARRIER();
+    rb->tail = (tail + count) & rb->mask;
 }
 
 uint32_t ringbuff_read_until(ringbuff_t *rb, uint8_t *buffer, uint32_t buffer_size, uint8_t token)
 {
-    uint32_t bytes = 0;
+    uint32_t bytes = 0, tail = rb->tail;
     uint8_t *data, dummy;
 
     data = buffer;
@@ -606,12 +795,27 @@ uint32_t ringbuff_read_until(ringbuff_t *rb, uint8_t *buffer, uint32_t buffer_si
         buffer_size = rb->size;
     }
 
+    // the delimiter position gives the message size straight away
+    if (BUFFER_INDEXED(rb, token))
+    {
+        if (rb->delimiters_tail == rb->delimiters_head) return 0;
+
+        BUFFER_BARRIER();
+        bytes = ((delimiters_first(rb) - tail) & rb->mask) + 1;
+        if (bytes > buffer_size) bytes = buffer_size;
+
+        return ringbuff_read(rb, buffer, bytes);
+    }
+
     if (ringbuff_count(rb, token) > 0)
     {
-        while (buffer_size > 0 && !BUFFER_IS_EMPTY(rb))
+        uint32_t head = rb->head;
+        BUFFER_BARRIER();
+
+        while (buffer_size > 0 && tail != head)
         {
-            *data = rb->buffer[rb->tail];
-            BUFFER_INC(rb, tail);
+            *data = rb->buffer[tail];
+            tail = (tail + 1) & rb->mask;
 
             buffer_size--;
             bytes++;
@@ -621,17 +825,19 @@ uint32_t ringbuff_read_until(ringbuff_t *rb, uint8_t *buffer, uint32_t buffer_si
         }
     }
 
+    ringbuff_commit(rb, bytes);
+
     return bytes;
 }
 
 uint32_t ringbuffer_used_space(ringbuff_t *rb)
 {
-    return ((rb->head - rb->tail) % rb->size);
+    return BUFFER_USED(rb);
 }
 
 uint32_t ringbuff_available_space(ringbuff_t *rb)
 {
-    return (rb->size - ((rb->head - rb->tail) % rb->size));
+    return (rb->size - BUFFER_USED(rb));
 }
 
 uint32_t ringbuff_is_full(ringbuff_t *rb)
@@ -650,6 +856,9 @@ void ringbuff_flush(ringbuff_t *rb)
     {
         rb->head = 0;
         rb->tail = 0;
+        rb->delimiters_head = 0;
+        rb->delimiters_tail = 0;
+        rb->delimiters_overflow = 0;
     }
 }
 
@@ -670,13 +879,16 @@ uint32_t ringbuff_count(ringbuff_t *rb, uint8_t byte)
     uint32_t tail, head;
     uint8_t data;
 
+    if (BUFFER_INDEXED(rb, byte))
+        return (rb->delimiters_head - rb->delimiters_tail);
+
     tail = rb->tail;
     head = rb->head;
 
     while (tail != head)
     {
         data = rb->buffer[tail];
-        tail = (tail + 1) % rb->size;
+        tail = (tail + 1) & rb->mask;
 
         if (data == byte) count++;
     }
@@ -695,7 +907,7 @@ void ringbuff_peek(ringbuff_t *rb, uint8_t *buffer, uint8_t peek_size)
     while (peek_size > 0 && tail != head)
     {
         *data++ = rb->buffer[tail];
-        tail = (tail + 1) % rb->size;
+        tail = (tail + 1) & rb->mask;
         peek_size--;
     }
 }
@@ -719,7 +931,7 @@ int32_t ringbuff_search(ringbuff_t *rb, const uint8_t *to_search, uint32_t size)
         do
         {
             data = rb->buffer[tail];
-            tail = (tail + 1) % rb->size;
+            tail = (tail + 1) & rb->mask;
             count++;
         } while (data != *s && tail != head);
 
@@ -731,7 +943,7 @@ int32_t ringbuff_search(ringbuff_t *rb, const uint8_t *to_search, uint32_t size)
         while (tail != head)
         {
             data = rb->buffer[tail];
-            tail = (tail + 1) % rb->size;
+            tail = (tail + 1) & rb->mask;
 
             s++;
             if (data != *s)
@@ -755,17 +967,19 @@ int32_t ringbuff_search2(ringbuff_t *rb, const uint8_t *to_search, uint32_t size
     if (!to_search)
         return -1;
 
-    uint32_t tail = rb->tail;
-    uint32_t match = 0;
+    uint32_t tail = rb->tail, start = rb->tail, head = rb->head;
+    uint32_t match = 0, consumed = 0;
 
     const uint8_t *s = to_search;
     uint8_t data;
 
+    BUFFER_BARRIER();
+
     // search for first byte
     do
     {
         data = rb->buffer[tail];
-        tail = (tail + 1) % rb->size;
+        tail = (tail + 1) & rb->mask;
 
         if (data == *s)
         {
@@ -774,20 +988,22 @@ int32_t ringbuff_search2(ringbuff_t *rb, const uint8_t *to_search, uint32_t size
 
             if (match == size)
             {
-                rb->tail = tail;
+                ringbuff_commit(rb, (tail - start) & rb->mask);
                 return 1;
             }
         }
         else
         {
             if (data == '\n')
-                rb->tail = tail;
+                consumed = (tail - start) & rb->mask;
 
             s = to_search;
             match = 0;
         }
 
-    } while (tail != rb->head);
+    } while (tail != head);
+
+    ringbuff_commit(rb, consumed);
 
     return -1;
 }